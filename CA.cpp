@@ -2,24 +2,40 @@
 #include "Cell.h"
 #include "Location.h"
 
-#include <cmath>
 #include <cassert>
 
 CA::CA(int L, int U, double fC, double fN) {
     this->L = L; // linear size of lattice
     int Q = 3; // colony size (hard-coded)
 
-    float df = std::log2(L)/std::log2(Q); // calc. hierarchy level
-    assert( (::ceilf(df) == df) || (::floorf(df) == df) ); // assure L and Q are compatible
-    int d = int(df); // hierarchy level
+    this->topo = Topology::get(L, Q); // shared wiring and addresses
+    int d = this->topo->d; // hierarchy level
+    this->d = d;
+
+    // level memories: signal bits for every cell, counters for representatives only
+    assert(U > Q); // counters never exceed U^k
+    this->levels.resize(d-1);
+    int Uk = 1;
+    int Qk = 1;
+    for (int k=1; k<d; k++) {
+        Uk *= U;
+        Qk *= Q;
+
+        Level& level = this->levels[k-1];
+        level.U = Uk;
+        level.Q = Qk;
+        level.L = L;
+        level.offset = (Qk - 1) / 2;
+        level.n = L / Qk;
+        level.addr = &this->topo->addr[k*L*L];
+        level.cells.resize(L*L);
+        level.count = Counters(9*level.n*level.n, Uk);
+    }
 
     // create cells
-    this->cells = new Cell**[L];
-    for (int i=0; i<L; i++) {
-        this->cells[i] = new Cell*[L];
-        for (int j=0; j<L; j++) {
-            this->cells[i][j] = new Cell(i,j,Q,U,d,fC,fN);
-        }
+    this->cells = new Cell*[L*L];
+    for (int idx=0; idx<L*L; idx++) {
+        this->cells[idx] = new Cell(*this->topo, idx, this->cells, this->levels.data(), fC, fN);
     }
 
     // output of global rule: LxL corrections
@@ -27,48 +43,39 @@ CA::CA(int L, int U, double fC, double fN) {
     for (int i=0; i<L; i++) {
         this->corrections[i] = new Location[L];
     }
-
-    // assign neighbors
-    for (int i=0; i<L; i++) {
-        for (int j=0; j<L; j++) {
-            Cell** neighbors = new Cell*[8];
-
-            int i_ = (i-1 == -1) ? L-1 : i-1;
-            int j_ = (j-1 == -1) ? L-1 : j-1;
-            int ip = (i+1) % L;
-            int jp = (j+1) % L;
-
-            neighbors[Location::N]  = this->cells[i_][j];
-            neighbors[Location::W]  = this->cells[i][j_];
-            neighbors[Location::E]  = this->cells[i][jp];
-            neighbors[Location::S]  = this->cells[ip][j];
-            neighbors[Location::NW] = this->cells[i_][j_];
-            neighbors[Location::NE] = this->cells[i_][jp];
-            neighbors[Location::SW] = this->cells[ip][j_];
-            neighbors[Location::SE] = this->cells[ip][jp];
-
-            this->cells[i][j]->setNeighbors(neighbors);
-        }
-    }
 }
 
 CA::~CA() {
+    for(int idx=0; idx<this->L*this->L; idx++) {
+        delete this->cells[idx];
+    }
     for(int i=0; i<this->L; i++) {
-        delete[] this->cells[i];
+        delete[] this->corrections[i];
     }
+    delete[] this->cells;
+    delete[] this->corrections;
 }
 
 void CA::reset() {
+    this->correctionList.clear();
+    for (Level& level : this->levels) {
+        level.age = 0;
+        level.count.clear();
+    }
     for(int i=0; i<this->L; i++) {
         for(int j=0; j<this->L; j++) {
             this->corrections[i][j] = Location::None;
-            this->cells[i][j]->reset();
+            this->cells[i*this->L + j]->reset();
         }
     }
 }
 
 Cell* CA::getCell(int i, int j) {
-    return this->cells[i][j];
+    return this->cells[i*this->L + j];
+}
+
+const std::vector<Correction>& CA::getCorrectionList() {
+    return this->correctionList;
 }
 
 Location** CA::step(bool** syndromes) {
@@ -76,28 +83,36 @@ Location** CA::step(bool** syndromes) {
     // 1. Measure syndrome, assign to cells
     for (int i=0; i<this->L; i++) {
         for (int j=0; j<this->L; j++) {
-            this->cells[i][j]->setSyndrome(syndromes[i][j]);
+            this->cells[i*this->L + j]->setSyndrome(syndromes[i][j]);
         }
     }
 
     // 2. Copy neighbor data
     for (int i=0; i<this->L; i++) {
         for (int j=0; j<this->L; j++) {
-            this->cells[i][j]->acquire();
+            this->cells[i*this->L + j]->acquire();
         }
     }
 
     // 3. Synchronous update: temp->actual
+    for (Level& level : this->levels) {
+        level.age = (level.age + 1) % level.U; // increment age
+    }
     for (int i=0; i<this->L; i++) {
         for (int j=0; j<this->L; j++) {
-            this->cells[i][j]->update();
+            this->cells[i*this->L + j]->update();
         }
     }
 
-    // 4. Perform (synchronized) local rule
+    // 4. Perform (synchronized) local rule, collect issued corrections
+    this->correctionList.clear();
     for (int i=0; i<this->L; i++) {
         for (int j=0; j<this->L; j++) {
-            this->corrections[i][j] = this->cells[i][j]->rule();
+            Location dir = this->cells[i*this->L + j]->rule();
+            this->corrections[i][j] = dir;
+            if (dir != Location::None) {
+                this->correctionList.push_back({i, j, dir});
+            }
         }
     }
 
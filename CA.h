@@ -2,22 +2,37 @@
 #define CA_H_
 
 #include "Cell.h"
+#include "Memory.h"
 #include "Location.h"
 #include "ToricCode.h"
+#include "Correction.h"
+#include "Topology.h"
+
+#include <memory>
+#include <vector>
 
 class CA {
 
     private:
         int L;
-        Cell*** cells;
+        int d; // hierarchy depth
+        std::shared_ptr<const Topology> topo;
+        Cell** cells; // row-major
+        std::vector<Level> levels; // memory of hierarchy levels 1..d-1
         Location** corrections;
+        std::vector<Correction> correctionList; // non-trivial entries of corrections
 
     public:
         CA(int L, int U, double fC, double fN);
         virtual ~CA();
         void reset();
         Cell* getCell(int i, int j);
+        int getL() { return this->L; };
+        int getDepth() { return this->d; };
+        Level& getLevel(int k) { return this->levels[k]; }; // memory of level k+1
+        const Topology& getTopology() { return *this->topo; };
         Location** step(bool** syndromes);
+        const std::vector<Correction>& getCorrectionList(); // corrections issued in last step
 
 };
 
@@ -2,141 +2,118 @@
 #include "Location.h"
 #include "Memory.h"
 
-#include <cmath>
 
-Cell::Cell(int row, int col, int Q, int U, int d, double fC, double fN) {
+Cell::Cell(const Topology& topo, int idx, Cell** grid, Level* levels, double fC, double fN) {
 
-    this->d = d;
+    this->d = topo.d;
 	this->fC = fC;
 	this->fN = fN;
 
-    this->neighbors = new Cell*[8];
+    this->idx = idx;
+    this->grid = grid;
+    this->levels = levels;
+    this->neighbors = topo.neighborsOf(idx); // shared wiring
     this->syndromes = new bool[9];
-    this->addr = locFromCoords(row, col);
-
-	this->memory = new Memory*[d-1];
-    for(int k=0; k<d; k++) {
-
-        int offset = int((std::pow(Q,k) - 1) / 2.0);
-        float krow = (row - offset) / std::pow(Q,k);
-        float kcol = (col - offset) / std::pow(Q,k);
-        Location kaddr = (int(krow) == krow && int(kcol) == kcol) ? locFromCoords(int(krow) % Q, (int(kcol) % Q)) : Location::None;
-    
-        if(k==0) {
-            this->addr = kaddr; // assign level-0 address
-        } else {
-            this->memory[k-1] = new Memory {kaddr, int(std::pow(U,k)), int(std::pow(Q,k))};
-        }
-    }
+    this->addr = topo.address(0, idx); // level-0 address
 
     this->reset();
 }
 
 Cell::~Cell() {
-    delete[] this->neighbors;
     delete[] this->syndromes;
-
-	for(int i=0; i<this->d-1; i++) {
-        delete[] this->memory[i];
-    }
 }
 
-void Cell::reset() {
+void Cell::reset() { // level ages and counters are reset by CA
     for (int i=0; i<9; i++) {
         this->syndromes[i] = 0;
     }
 
 	for (int k=0; k<this->d-1; k++) {
-        this->memory[k]->age = 0;
-
-        for (int i=0; i<4; i++) { 
-            this->memory[k]->flipSig[i] = 0;
-            this->memory[k]->n_flipSig[i] = 0;
-        }
-
-        for (int i=0; i<8; i++) {
-            this->memory[k]->countSig[i] = 0;
-            this->memory[k]->n_countSig[i] = 0;
-        }
-
-        for (int i=0; i<9; i++) {
-            this->memory[k]->count[i] = 0;
-        }
-        
+        this->levels[k].cells[this->idx] = Memory {};
     }
 }
 
-void Cell::setNeighbors(Cell** neighbors) {
-    this->neighbors = neighbors;
-}
-
 void Cell::setSyndrome(bool syndrome) {
     this->syndromes[Location::C] = syndrome;
 }
 
 Memory* Cell::getMemory(int k) {
-    return this->memory[k];
+    return &this->levels[k].cells[this->idx];
 }
 
 void Cell::acquire() {
 
+    Cell* nb[8]; // resolve shared wiring once
+    for (int i=0; i<8; i++) {
+        nb[i] = this->neighbor(i);
+    }
+
     // copy neighbor center syndrome
     for (int i=0; i<8; i++) {
-        this->syndromes[i] = this->neighbors[i]->syndromes[Location::C];
+        this->syndromes[i] = nb[i]->syndromes[Location::C];
     }
 
 	// propagate signals (from opposite neighbor in same direction)
     for (int k=0; k<this->d-1; k++) {
+        const std::vector<Memory>& mem = this->levels[k].cells;
+        uint8_t countSig = 0;
+        uint8_t flipSig = 0;
         for (int i=0; i<8; i++)
-            this->memory[k]->n_countSig[i] = this->neighbors[oppositeLoc(Location(i))]->memory[k]->countSig[i];
+            countSig |= mem[this->neighbors[oppositeLoc(Location(i))]].countSig & (1 << i);
         for (int i=0; i<4; i++)
-            this->memory[k]->n_flipSig[i] = this->neighbors[oppositeLoc(Location(i))]->memory[k]->flipSig[i];
+            flipSig |= mem[this->neighbors[oppositeLoc(Location(i))]].flipSig & (1 << i);
 
+        this->levels[k].cells[this->idx].n_countSig = countSig;
+        this->levels[k].cells[this->idx].n_flipSig = flipSig;
     }
 }
 
-void Cell::update() {
+void Cell::update() { // level ages are incremented by CA
     for (int k=0; k<this->d-1; k++) {
-        this->memory[k]->age = (this->memory[k]->age + 1) % this->memory[k]->U; // increment age
+        Level& level = this->levels[k];
+        Memory& mem = level.cells[this->idx];
 
-        if (this->memory[k]->addr != Location::None) { // hierarchy representatives
-            for (int i=0; i<8; i++)
-                this->memory[k]->countSig[i] = this->syndromes[Location::C]; // broadcast
+        if (level.addr[this->idx] != Location::None) { // hierarchy representatives
+            mem.countSig = this->syndromes[Location::C] ? 0xff : 0; // broadcast
 
 			// update count array
-			this->memory[k]->count[Location::C] += this->syndromes[Location::C];
+            int r = 9*level.repIndex(this->idx);
+			level.count.add(r + Location::C, this->syndromes[Location::C]);
 			for (int i=0; i<8; i++)
-				this->memory[k]->count[i] += this->memory[k]->n_countSig[oppositeLoc(Location(i))]; // direction it came from
+				level.count.add(r + i, (mem.n_countSig >> oppositeLoc(Location(i))) & 1); // direction it came from
 
         } else { // copy signals for all non-representatives
-            for (int i=0; i<8; i++)
-                this->memory[k]->countSig[i] = this->memory[k]->n_countSig[i];
-            for (int i=0; i<4; i++)
-                this->memory[k]->flipSig[i] = this->memory[k]->n_flipSig[i];
+            mem.countSig = mem.n_countSig;
+            mem.flipSig = mem.n_flipSig;
         }
     }
 }
 
 Location Cell::rule() {
 	for (int k=0; k<this->d-1; k++) {
-        if (this->memory[k]->age == 0 && this->memory[k]->addr != Location::None) { // at t=U -> decide flipSig
+        Level& level = this->levels[k];
+        Memory& mem = level.cells[this->idx];
+        Location kaddr = Location(level.addr[this->idx]);
+
+        if (level.age == 0 && kaddr != Location::None) { // at t=U -> decide flipSig
 
-            bool* syndromes = new bool[9]; // k-level syndrome..
+            bool syndromes[9]; // k-level syndrome..
+            int r = 9*level.repIndex(this->idx);
             for (int i=0; i<9; i++) {
                 double f = (i == Location::C) ? this->fC : this->fN;
-                syndromes[i] = this->memory[k]->count[i] >= f * this->memory[k]->U; // ..determined from k-level count
-                this->memory[k]->count[i] = 0; // reset count
+                syndromes[i] = level.count.get(r + i) >= f * level.U; // ..determined from k-level count
+                level.count.set(r + i, 0); // reset count
             }
 
-            Location dir = this->harringtonRule(this->memory[k]->addr, syndromes); // higher-level rule
+            Location dir = this->harringtonRule(kaddr, syndromes); // higher-level rule
             if (dir != Location::None) // emit flipSig
-				this->memory[k]->flipSig[dir] = 1;
+				mem.flipSig |= 1 << dir;
         }
-        else if (this->memory[k]->age == this->memory[k]->Q) { // at t=U+Q, do correction chain, if applicable
+        else if (level.age == level.Q) { // at t=U+Q, do correction chain, if applicable
 
             for (int i=0; i<4; i++) {
-                if (this->memory[k]->flipSig[i]) {
-					this->memory[k]->flipSig[i] = 0;
+                if (mem.flipSig & (1 << i)) {
+					mem.flipSig &= ~(1 << i);
 					return Location(i); // issue correction in direction of (first) flipSig
                 } 
             }
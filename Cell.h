@@ -3,19 +3,24 @@
 
 #include "Memory.h"
 #include "Location.h"
+#include "Topology.h"
 
 class Cell {
     private:
         Location addr; // level-0 address (within k=0 hierarchy)
-        Cell** neighbors; // 8 nearest neighbor cells
-        Memory** memory; // one memory per hierarchy level
+        Cell** grid; // all cells of the CA, row-major
+        const int* neighbors; // grid indices of 8 nearest neighbors (owned by Topology)
+        int idx; // index of this cell in grid
+        Level* levels; // memory of hierarchy levels 1..d-1 (owned by CA)
         bool* syndromes; // anyon presence (N,W,E,S,NW,NE,SW,SE,C)
 
         int d; // max. hierarchy level
         double fN; // threshold for count of neighbor signals
         double fC; // threshold for count of own syndrome
+
+        Cell* neighbor(int i) { return this->grid[this->neighbors[i]]; };
     public:
-        Cell(int row, int col, int Q, int U, int d, double fC, double fN);
+        Cell(const Topology& topo, int idx, Cell** grid, Level* levels, double fC, double fN);
         virtual ~Cell();
         void reset();
 
@@ -23,11 +28,10 @@ class Cell {
         void update(); // move signal data from temp to actual (or broadcast)
         Location rule(); // apply local rule to actual data (or higher-level rule)
 
-        void setNeighbors(Cell**); // assign neighbor cells
         void setSyndrome(bool syndrome); // set current center syndrome (i.e. anyon presence)
         Memory* getMemory(int k); // get k-th level memory of this cell
 
-        Location harringtonRule(Location addr, bool* syndromes);
+        static Location harringtonRule(Location addr, bool* syndromes); // level-independent local rule
 };
 
 #endif
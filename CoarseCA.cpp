@@ -0,0 +1,217 @@
+#include "CoarseCA.h"
+#include "Cell.h"
+#include "Location.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// row/col offsets of N,W,E,S,NW,NE,SW,SE
+const int DR[8] = {-1, 0, 0, 1, -1, -1, 1, 1};
+const int DC[8] = { 0,-1, 1, 0, -1,  1,-1, 1};
+
+}
+
+CoarseCA::CoarseCA(int L, int U, double fC, double fN) {
+    this->L = L; // linear size of lattice
+    this->fC = fC;
+    this->fN = fN;
+    int Q = 3; // colony size (hard-coded)
+
+    this->topo = Topology::get(L, Q); // shared wiring and addresses
+    this->d = this->topo->d;
+
+    assert(U > Q); // a level's flip chain must complete within its work period
+    // levels 1..d-1: representatives sit at the centers of Q^k colonies
+    int Uk = 1;
+    int Qk = 1;
+    for (int k=1; k<this->d; k++) {
+        Uk *= U;
+        Qk *= Q;
+
+        CoarseLevel lvl;
+        lvl.U = Uk;
+        lvl.Q = Qk;
+        lvl.n = L / Qk;
+        lvl.offset = (Qk - 1) / 2;
+        lvl.reps = &this->topo->reps[k];
+        lvl.k = k;
+        lvl.prefix.resize(lvl.n*lvl.n*(Qk+1));
+        lvl.base.resize(lvl.n*lvl.n*9);
+        lvl.pending.resize(lvl.n*lvl.n);
+        this->levels.push_back(lvl);
+    }
+
+    this->chains.resize(L*L);
+    this->emitted.resize(L*L);
+
+    // output of global rule: LxL corrections
+    this->corrections = new Location*[L];
+    for (int i=0; i<L; i++) {
+        this->corrections[i] = new Location[L];
+    }
+
+    this->reset();
+}
+
+CoarseCA::~CoarseCA() {
+    for (int i=0; i<this->L; i++) {
+        delete[] this->corrections[i];
+    }
+    delete[] this->corrections;
+}
+
+void CoarseCA::reset() {
+    this->t = 0;
+    this->correctionList.clear();
+    this->touched.clear();
+
+    for (CoarseLevel& lvl : this->levels) {
+        std::fill(lvl.prefix.begin(), lvl.prefix.end(), 0);
+        std::fill(lvl.base.begin(), lvl.base.end(), 0);
+        std::fill(lvl.pending.begin(), lvl.pending.end(), 0);
+    }
+    std::fill(this->chains.begin(), this->chains.end(), 0);
+    std::fill(this->emitted.begin(), this->emitted.end(), -1);
+
+    for (int i=0; i<this->L; i++) {
+        for (int j=0; j<this->L; j++) {
+            this->corrections[i][j] = Location::None;
+        }
+    }
+}
+
+const std::vector<Correction>& CoarseCA::getCorrectionList() {
+    return this->correctionList;
+}
+
+// At the end of a work period: threshold the counts accumulated since the
+// last evaluation and apply the higher-level rule.
+void CoarseCA::evaluate(CoarseLevel& lvl) {
+    int H = lvl.Q + 1; // prefix ring length
+    int now = this->t % H; // slot of prefix sum at t
+    int delayed = (this->t + 1) % H; // slot of prefix sum at t-Q
+
+    for (int a=0; a<lvl.n; a++) {
+        for (int b=0; b<lvl.n; b++) {
+            int r = a*lvl.n + b;
+            int cell = (*lvl.reps)[r];
+            if (this->emitted[cell] == this->t) { // pre-empted by lower-level correction
+                continue;
+            }
+
+            bool syn[9];
+            for (int i=0; i<9; i++) {
+                int P;
+                if (i == Location::C) {
+                    P = lvl.prefix[r*H + now];
+                } else {
+                    int nb = ((a + DR[i] + lvl.n) % lvl.n)*lvl.n + (b + DC[i] + lvl.n) % lvl.n;
+                    P = lvl.prefix[nb*H + delayed];
+                }
+                double f = (i == Location::C) ? this->fC : this->fN;
+                syn[i] = P - lvl.base[r*9 + i] >= f * lvl.U;
+                lvl.base[r*9 + i] = P; // reset count
+            }
+
+            Location dir = Cell::harringtonRule(this->topo->address(lvl.k, cell), syn);
+            if (dir != Location::None) {
+                lvl.pending[r] |= 1 << dir;
+            }
+        }
+    }
+}
+
+// Q steps after evaluation: every cell on the chain from a representative
+// towards its neighbor issues the pending correction.
+void CoarseCA::issueChains(CoarseLevel& lvl) {
+    for (int a=0; a<lvl.n; a++) {
+        for (int b=0; b<lvl.n; b++) {
+            int r = a*lvl.n + b;
+            for (int dir=0; dir<4 && lvl.pending[r]; dir++) {
+                if (!(lvl.pending[r] & (1 << dir))) {
+                    continue;
+                }
+                for (int m=0; m<lvl.Q; m++) {
+                    int row = (lvl.offset + a*lvl.Q + m*DR[dir] + this->L) % this->L;
+                    int col = (lvl.offset + b*lvl.Q + m*DC[dir] + this->L) % this->L;
+                    int cell = row*this->L + col;
+                    if (this->chains[cell] == 0) {
+                        this->touched.push_back(cell);
+                    }
+                    this->chains[cell] |= 1 << dir;
+                }
+            }
+        }
+    }
+
+    for (int cell : this->touched) {
+        if (this->emitted[cell] != this->t) {
+            int dir = 0;
+            while (!(this->chains[cell] & (1 << dir))) { // first flip direction
+                dir++;
+            }
+            this->corrections[cell / this->L][cell % this->L] = Location(dir);
+            this->emitted[cell] = this->t;
+
+            int row = cell / this->L - lvl.offset;
+            int col = cell % this->L - lvl.offset;
+            if (row % lvl.Q == 0 && col % lvl.Q == 0) { // representative: flip issued
+                lvl.pending[(row / lvl.Q)*lvl.n + col / lvl.Q] &= ~(1 << dir);
+            }
+        }
+        this->chains[cell] = 0;
+    }
+    this->touched.clear();
+}
+
+Location** CoarseCA::step(bool** syndromes) {
+    this->t += 1;
+
+    // 1. Accumulate representative syndromes
+    for (CoarseLevel& lvl : this->levels) {
+        int H = lvl.Q + 1;
+        for (int r=0; r<lvl.n*lvl.n; r++) {
+            int cell = (*lvl.reps)[r];
+            bool s = syndromes[cell / this->L][cell % this->L];
+            lvl.prefix[r*H + this->t % H] = lvl.prefix[r*H + (this->t - 1) % H] + s;
+        }
+    }
+
+    // 2. Higher-level rules, lowest level first (a cell issues at most one correction)
+    for (CoarseLevel& lvl : this->levels) {
+        int age = this->t % lvl.U;
+        if (age == 0) {
+            this->evaluate(lvl);
+        } else if (age == lvl.Q) {
+            this->issueChains(lvl);
+        }
+    }
+
+    // 3. Level-0 rule for all remaining cells, collect issued corrections
+    this->correctionList.clear();
+    for (int i=0; i<this->L; i++) {
+        for (int j=0; j<this->L; j++) {
+            if (this->emitted[i*this->L + j] != this->t) {
+                Location dir = Location::None;
+                Location a = this->topo->address(0, i*this->L + j);
+                if (a != Location::C && syndromes[i][j]) {
+                    bool syn[9];
+                    const int* nb = this->topo->neighborsOf(i*this->L + j);
+                    for (int l=0; l<8; l++) {
+                        syn[l] = syndromes[nb[l] / this->L][nb[l] % this->L];
+                    }
+                    syn[Location::C] = 1;
+                    dir = Cell::harringtonRule(a, syn);
+                }
+                this->corrections[i][j] = dir;
+            }
+            if (this->corrections[i][j] != Location::None) {
+                this->correctionList.push_back({i, j, this->corrections[i][j]});
+            }
+        }
+    }
+
+    return this->corrections;
+}
@@ -0,0 +1,64 @@
+#ifndef COARSECA_H_
+#define COARSECA_H_
+
+#include "Location.h"
+#include "Correction.h"
+#include "Topology.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Abstracted-hierarchy engine: same corrections as CA, but level-k counts
+// are computed directly at the colony representatives instead of relaying
+// countSig/flipSig through every cell. Each representative keeps running
+// (prefix) sums of its syndrome over time; a level-k count is a difference
+// of two prefix sums of the neighboring representative, delayed by the
+// Q^k steps the signal would have travelled. Flip chains are only
+// materialized at the step they are issued.
+// Assumes U > Q, as does CA.
+
+struct CoarseLevel {
+    int U; // work period
+    int Q; // colony size = distance between representatives
+    int n; // representatives per row/column
+    int offset; // row/col of first representative
+
+    int k; // hierarchy level
+    const std::vector<int>* reps; // representative cells, row-major (owned by Topology)
+    std::vector<int> prefix; // per rep: ring of Q+1 prefix sums of own syndrome
+    std::vector<int> base; // per rep: 9 prefix sums at last evaluation (N,W,E,S,NW,NE,SW,SE,C)
+    std::vector<uint8_t> pending; // per rep: flip directions (bit N,W,E,S) not yet issued
+};
+
+class CoarseCA {
+
+    private:
+        int L;
+        int d; // hierarchy depth
+        double fC;
+        double fN;
+        int t; // steps since reset
+
+        std::shared_ptr<const Topology> topo;
+        std::vector<CoarseLevel> levels; // levels 1..d-1
+        std::vector<uint8_t> chains; // per cell: flip directions of chains passing through
+        std::vector<int> touched; // cells with non-zero chains
+        std::vector<int> emitted; // per cell: last step a higher-level correction was issued
+
+        Location** corrections;
+        std::vector<Correction> correctionList;
+
+        void evaluate(CoarseLevel& lvl);
+        void issueChains(CoarseLevel& lvl);
+
+    public:
+        CoarseCA(int L, int U, double fC, double fN);
+        virtual ~CoarseCA();
+        void reset();
+        Location** step(bool** syndromes);
+        const std::vector<Correction>& getCorrectionList(); // corrections issued in last step
+
+};
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef CORRECTION_H_
+#define CORRECTION_H_
+
+#include "Location.h"
+
+struct Correction {
+
+    int row; // cell issuing the correction
+    int col;
+    Location dir; // N,W,E,S
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "Harness.h"
+#include "CoarseCA.h"
+#include "Memory.h"
+#include "Trial.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+void mix(uint64_t& h, int v) {
+    for (int b=0; b<4; b++) {
+        h ^= (v >> (8*b)) & 0xff;
+        h *= FNV_PRIME;
+    }
+}
+
+struct Params {
+    int U;
+    double fC;
+    double fN;
+};
+
+std::string tracePath(int L, const Params& par, int seed) {
+    return "./data/golden/trace_L=" + std::to_string(L) + "_U=" + std::to_string(par.U)
+        + "_fC=" + std::to_string(par.fC) + "_fN=" + std::to_string(par.fN)
+        + "_s=" + std::to_string(seed) + ".txt";
+}
+
+}
+
+uint64_t hashState(ToricCode& tc, CA& ca, int L) {
+    uint64_t h = FNV_OFFSET;
+
+    for (int i=0; i<L; i++) {
+        for (int j=0; j<L; j++) {
+            mix(h, tc.getQubit(i,j,0));
+            mix(h, tc.getQubit(i,j,1));
+
+            for (int k=0; k<ca.getDepth()-1; k++) {
+                const Level& level = ca.getLevel(k);
+                const Memory& mem = level.cells[i*L + j];
+                bool rep = level.addr[i*L + j] != Location::None;
+
+                mix(h, level.age);
+                for (int l=0; l<8; l++) {
+                    mix(h, (mem.countSig >> l) & 1);
+                    mix(h, (mem.n_countSig >> l) & 1);
+                }
+                for (int l=0; l<4; l++) {
+                    mix(h, (mem.flipSig >> l) & 1);
+                    mix(h, (mem.n_flipSig >> l) & 1);
+                }
+                for (int l=0; l<9; l++) { // relay-only cells have no counters
+                    mix(h, rep ? level.count.get(9*level.repIndex(i*L + j) + l) : 0);
+                }
+            }
+        }
+    }
+    return h;
+}
+
+std::vector<uint64_t> recordTrace(int L, int U, double fC, double fN, double p, int seed, int steps) {
+    ToricCode tc(L);
+    CA ca(L,U,fC,fN);
+    tc.setSeed(seed);
+
+    std::vector<uint64_t> trace;
+    for (int t=0; t<steps; t++) {
+        tc.noise(p);
+        decodeStep(tc, ca);
+        trace.push_back(hashState(tc, ca, L));
+    }
+    return trace;
+}
+
+bool writeTrace(const std::string& path, const std::vector<uint64_t>& trace) {
+    std::ofstream file(path, std::ios_base::out); // overwrite
+    for (uint64_t h : trace) {
+        file << std::hex << h << '\n';
+    }
+    return bool(file);
+}
+
+std::vector<uint64_t> readTrace(const std::string& path) {
+    std::ifstream file(path);
+    std::vector<uint64_t> trace;
+    uint64_t h;
+    while (file >> std::hex >> h) {
+        trace.push_back(h);
+    }
+    return trace;
+}
+
+int compareTraces(const std::vector<uint64_t>& golden, const std::vector<uint64_t>& trace) {
+    size_t n = std::min(golden.size(), trace.size());
+    for (size_t t=0; t<n; t++) {
+        if (golden[t] != trace[t]) {
+            return int(t);
+        }
+    }
+    return (golden.size() == trace.size()) ? -1 : int(n);
+}
+
+bool runHarness(int steps, int seeds, bool record) {
+    std::vector<int> Ls = {9, 27, 81};
+    std::vector<Params> params = {{10, 9/10., 4/10.}, {10, 8/10., 3/10.}, {20, 9/10., 5/10.}, {5, 7/10., 2/10.}};
+    std::vector<double> rhos = {1e-3, 1e-2, 5e-2, 2e-1, 5e-1}; // high rates keep occupancy above fC for the top level
+    double p = 1e-2;
+
+    if (record) {
+        std::filesystem::create_directories("./data/golden");
+    }
+    bool ok = true;
+
+    for (int L : Ls) {
+        for (const Params& par : params) {
+            CA a(L, par.U, par.fC, par.fN);
+            CoarseCA b(L, par.U, par.fC, par.fN);
+
+            // long enough for the top level to finish a work period and issue its flip chain
+            const Level& top = a.getLevel(a.getDepth()-2);
+            int n = std::max(steps, top.U + top.Q + 1);
+            int fuzzSteps = (top.U < steps) ? std::max(n, 2*top.U + top.Q + 1) : n; // a second top-level period where it is cheap
+
+            bool passed = true;
+            std::cout << "L=" << L << " U=" << par.U << " fC=" << par.fC << " fN=" << par.fN << " (" << n << " steps): ";
+
+            // golden traces: written only by "harness record", compared otherwise
+            for (int s=0; s<seeds; s++) {
+                std::string path = tracePath(L, par, s);
+                std::vector<uint64_t> trace = recordTrace(L, par.U, par.fC, par.fN, p, s, n);
+
+                if (record) {
+                    if (!writeTrace(path, trace)) {
+                        std::cout << "[cannot write " << path << "] ";
+                        passed = false;
+                    }
+                    continue;
+                }
+                if (!std::filesystem::exists(path)) {
+                    std::cout << "[missing golden " << path << "] ";
+                    passed = false;
+                    continue;
+                }
+                int t = compareTraces(readTrace(path), trace);
+                if (t >= 0) {
+                    std::cout << "[trace s=" << s << " diverges at step " << t << "] ";
+                    passed = false;
+                }
+            }
+
+            // differential fuzzing: faithful vs. abstracted hierarchy
+            for (double rho : rhos) {
+                for (int s=0; s<seeds; s++) {
+                    Divergence div = fuzzDiff(a, b, L, rho, s, fuzzSteps);
+                    if (div.step >= 0) {
+                        std::cout << "[fuzz rho=" << rho << " s=" << s << " diverges at step " << div.step
+                                  << " cell (" << div.row << "," << div.col << "): "
+                                  << div.a << " vs " << div.b << "] ";
+                        passed = false;
+                    }
+                }
+            }
+            std::cout << (passed ? "ok" : "FAILED") << std::endl;
+            ok = ok && passed;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,81 @@
+#ifndef HARNESS_H_
+#define HARNESS_H_
+
+#include "Location.h"
+#include "ToricCode.h"
+#include "CA.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Reference traces and differential fuzzing for decoder engines.
+// An engine provides reset() and Location** step(bool** syndromes).
+
+struct Divergence {
+    int step = -1; // -1: no divergence found
+    int row = -1;
+    int col = -1;
+    Location a = Location::None; // correction issued by first engine
+    Location b = Location::None; // correction issued by second engine
+};
+
+uint64_t hashState(ToricCode& tc, CA& ca, int L); // FNV-1a over qubits and all cell memories
+std::vector<uint64_t> recordTrace(int L, int U, double fC, double fN, double p, int seed, int steps);
+bool writeTrace(const std::string& path, const std::vector<uint64_t>& trace);
+std::vector<uint64_t> readTrace(const std::string& path);
+int compareTraces(const std::vector<uint64_t>& golden, const std::vector<uint64_t>& trace); // first differing step, -1 if equal
+
+// Golden traces + fuzzing over L=9/27/81 and several (U,fC,fN). Runs at least
+// steps, more where the top level needs longer. record rewrites the goldens.
+bool runHarness(int steps, int seeds, bool record = false);
+
+// Feed identical random syndrome sequences to two engines and report the
+// first step and cell at which their corrections differ. Syndromes appear
+// with probability rho and vanish with probability 1/50 per step, so they
+// persist long enough to trigger the higher-level rules.
+template<class EngineA, class EngineB>
+Divergence fuzzDiff(EngineA& a, EngineB& b, int L, double rho, int seed, int steps) {
+    std::mt19937 randGen(seed);
+    std::bernoulli_distribution birth(rho);
+    std::bernoulli_distribution death(1/50.);
+
+    bool** syndromes = new bool*[L];
+    for (int i=0; i<L; i++) {
+        syndromes[i] = new bool[L]();
+    }
+
+    a.reset();
+    b.reset();
+
+    Divergence div;
+    for (int t=0; t<steps && div.step < 0; t++) {
+        for (int i=0; i<L; i++) {
+            for (int j=0; j<L; j++) {
+                syndromes[i][j] = syndromes[i][j] ? !death(randGen) : birth(randGen);
+            }
+        }
+
+        Location** ca = a.step(syndromes);
+        Location** cb = b.step(syndromes);
+
+        for (int i=0; i<L && div.step < 0; i++) {
+            for (int j=0; j<L; j++) {
+                if (ca[i][j] != cb[i][j]) {
+                    div = {t, i, j, ca[i][j], cb[i][j]};
+                    break;
+                }
+            }
+        }
+    }
+
+    for (int i=0; i<L; i++) {
+        delete[] syndromes[i];
+    }
+    delete[] syndromes;
+
+    return div;
+}
+
+#endif
@@ -3,18 +3,96 @@
 
 #include "Location.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Signal bits of one cell at one hierarchy level. Relay-only cells need
+// nothing else; counters live with the level representatives (see Level).
 struct Memory {
 
-    Location addr;
+    uint8_t countSig = 0; // bits N,W,E,S,NW,NE,SW,SE
+    uint8_t n_countSig = 0;
+    uint8_t flipSig = 0; // bits N,W,E,S
+    uint8_t n_flipSig = 0;
+};
+
+// Unsigned counters stored at the narrowest width that can hold max.
+class Counters {
+    private:
+        int width; // bytes per counter: 1, 2 or 4
+        std::vector<uint8_t> c8;
+        std::vector<uint16_t> c16;
+        std::vector<uint32_t> c32;
+
+    public:
+        Counters(int n = 0, long max = 0) {
+            this->width = (max <= UINT8_MAX) ? 1 : (max <= UINT16_MAX) ? 2 : 4;
+            switch (this->width) {
+                case 1: this->c8.resize(n); break;
+                case 2: this->c16.resize(n); break;
+                case 4: this->c32.resize(n); break;
+            }
+        }
+
+        int get(int i) const {
+            switch (this->width) {
+                case 1: return this->c8[i];
+                case 2: return this->c16[i];
+                default: return this->c32[i];
+            }
+        }
+
+        void add(int i, int v) {
+            switch (this->width) {
+                case 1: this->c8[i] += v; break;
+                case 2: this->c16[i] += v; break;
+                default: this->c32[i] += v; break;
+            }
+        }
+
+        void set(int i, int v) {
+            switch (this->width) {
+                case 1: this->c8[i] = v; break;
+                case 2: this->c16[i] = v; break;
+                default: this->c32[i] = v; break;
+            }
+        }
+
+        void clear() {
+            std::fill(this->c8.begin(), this->c8.end(), 0);
+            std::fill(this->c16.begin(), this->c16.end(), 0);
+            std::fill(this->c32.begin(), this->c32.end(), 0);
+        }
+
+        int getWidth() const { return this->width; };
+        void* data() { // contiguous counters of getWidth() bytes each
+            switch (this->width) {
+                case 1: return this->c8.data();
+                case 2: return this->c16.data();
+                default: return this->c32.data();
+            }
+        }
+};
+
+// All memory of one hierarchy level k >= 1.
+struct Level {
+
     int U; // work period (of this level)
     int Q; // colony size
-    int age = 0; // time step % U
+    int age = 0; // time step % U, common to all cells
+
+    int L; // linear size of lattice
+    int offset; // row/col of first representative
+    int n; // representatives per row/column
+
+    const int8_t* addr; // k-level address per cell, None if not a representative (owned by Topology)
+    std::vector<Memory> cells; // signal bits per cell, row-major
+    Counters count; // 9 per representative (N,W,E,S,NW,NE,SW,SE,C), never exceed U
 
-    bool countSig[8] = {0,0,0,0,0,0,0,0}; // N,W,E,S,NW,NE,SW,SE
-    bool n_countSig[8] = {0,0,0,0,0,0,0,0};
-    bool flipSig[4] = {0,0,0,0}; // N,W,E,S
-    bool n_flipSig[4] = {0,0,0,0};
-    int count[9] = {0,0,0,0,0,0,0,0,0}; // N,W,E,S,NW,NE,SW,SE,C
+    int repIndex(int cell) const { // row-major index among representatives
+        return ((cell / this->L - this->offset) / this->Q)*this->n + (cell % this->L - this->offset) / this->Q;
+    }
 };
 
 #endif
@@ -0,0 +1,298 @@
+#include "Shard.h"
+#include "ToricCode.h"
+#include "CA.h"
+#include "Trial.h"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using PointKey = std::tuple<int, double, int, double, double>; // L, p, U, fC, fN
+
+std::string number(double x) { // shortest text that reads back as x
+    char buf[32];
+    return std::string(buf, std::to_chars(buf, buf + sizeof(buf), x).ptr);
+}
+
+std::string pointName(const ShardSpec& spec) {
+    return "L=" + std::to_string(spec.L) + "_p=" + number(spec.p) + "_U=" + std::to_string(spec.U)
+        + "_fC=" + number(spec.fC) + "_fN=" + number(spec.fN);
+}
+
+fs::path manifestPath(const std::string& dir, const ShardSpec& spec) {
+    return fs::path(dir) / (shardName(spec) + ".manifest");
+}
+
+PointKey pointKey(const ShardSpec& spec) {
+    return {spec.L, spec.p, spec.U, spec.fC, spec.fN};
+}
+
+bool readManifest(const fs::path& path, ShardSpec& spec, std::string& results) {
+    std::ifstream file(path);
+    std::map<std::string, std::string> kv;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t eq = line.find('=');
+        if (eq != std::string::npos) {
+            kv[line.substr(0, eq)] = line.substr(eq+1);
+        }
+    }
+    if (kv["status"] != "complete") {
+        return false;
+    }
+    try { // written with 17 digits, so values read back exactly
+        spec = {std::stoi(kv["L"]), std::stod(kv["p"]), std::stoi(kv["U"]), std::stod(kv["fC"]), std::stod(kv["fN"]),
+                std::stoi(kv["seed_begin"]), std::stoi(kv["seed_end"])};
+    } catch (const std::logic_error&) { // missing or malformed field
+        return false;
+    }
+    results = kv["results"];
+    return true;
+}
+
+// Appends the rows of a shard's results file. False unless they are
+// exactly the seeds seedBegin, ..., seedEnd-1 in order.
+bool readResults(const fs::path& path, const ShardSpec& spec, std::vector<std::pair<int, int>>& rows) {
+    std::ifstream file(path);
+    int next = spec.seedBegin;
+    int seed;
+    char sep;
+    int count;
+    while (file >> seed >> sep >> count) {
+        if (sep != ',' || seed != next || next >= spec.seedEnd) {
+            return false;
+        }
+        rows.push_back({seed, count});
+        next += 1;
+    }
+    return file.eof() && next == spec.seedEnd; // eof: no trailing garbage, no read error
+}
+
+}
+
+std::string shardName(const ShardSpec& spec) {
+    return pointName(spec) + "_s=" + std::to_string(spec.seedBegin) + "-" + std::to_string(spec.seedEnd);
+}
+
+std::vector<ShardSpec> planShards(const std::vector<int>& Ls, const std::vector<double>& ps,
+                                  int U, double fC, double fN, int N, int trialsPerShard) {
+    std::vector<ShardSpec> shards;
+    for (int L : Ls) {
+        for (double p : ps) {
+            for (int s=0; s<N; s+=trialsPerShard) {
+                shards.push_back({L, p, U, fC, fN, s, std::min(s + trialsPerShard, N)});
+            }
+        }
+    }
+    return shards;
+}
+
+int runShard(const ShardSpec& spec, const std::string& dir, long memCapMB) {
+    if (memCapMB > 0) { // address-space cap: allocations beyond it fail with bad_alloc
+        struct rlimit lim;
+        lim.rlim_cur = lim.rlim_max = rlim_t(memCapMB) << 20;
+        if (setrlimit(RLIMIT_AS, &lim) != 0) {
+            std::cerr << shardName(spec) << ": cannot set memory cap\n";
+            return 1;
+        }
+    }
+
+    fs::create_directories(dir);
+    std::string name = shardName(spec);
+    fs::path results = fs::path(dir) / (name + ".csv");
+    fs::path manifest = fs::path(dir) / (name + ".manifest");
+
+    try {
+        ToricCode tc(spec.L);
+        CA ca(spec.L, spec.U, spec.fC, spec.fN);
+
+        std::ofstream counts_file(results, std::ios_base::out); // overwrite partial results of earlier attempts
+        for (int s=spec.seedBegin; s<spec.seedEnd; s++) {
+            tc.setSeed(s);
+            counts_file << s << "," << lifetime(tc, ca, spec.p) << std::endl;
+        }
+        if (!counts_file) {
+            std::cerr << name << ": cannot write " << results << '\n';
+            return 1;
+        }
+    } catch (const std::bad_alloc&) {
+        std::cerr << name << ": memory cap of " << memCapMB << " MB exceeded\n";
+        return 1;
+    }
+
+    // manifest last, renamed into place: its presence marks the shard complete
+    fs::path tmp = manifest;
+    tmp += ".tmp";
+    {
+        std::ofstream file(tmp, std::ios_base::out);
+        file << std::setprecision(17)
+             << "L=" << spec.L << '\n' << "p=" << spec.p << '\n'
+             << "U=" << spec.U << '\n' << "fC=" << spec.fC << '\n' << "fN=" << spec.fN << '\n'
+             << "seed_begin=" << spec.seedBegin << '\n' << "seed_end=" << spec.seedEnd << '\n'
+             << "results=" << results.filename().string() << '\n'
+             << "status=complete\n";
+    }
+    fs::rename(tmp, manifest);
+    return 0;
+}
+
+int launchShards(const std::vector<ShardSpec>& shards, const std::string& dir, long memCapMB, int procs) {
+    std::map<pid_t, ShardSpec> running;
+    int failed = 0;
+
+    auto reap = [&]() { // false once there are no children left to wait for
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0) {
+            if (errno != ECHILD) { // e.g. EINTR: wait again
+                return true;
+            }
+            failed += int(running.size()); // lost track of these
+            running.clear();
+            return false;
+        }
+        std::string name = shardName(running[pid]);
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            std::cout << name << ": done\n";
+        } else {
+            std::cout << name << ": FAILED (" << (WIFSIGNALED(status) ? "signal " + std::to_string(WTERMSIG(status))
+                                                                        : "exit " + std::to_string(WEXITSTATUS(status))) << ")\n";
+            failed += 1;
+        }
+        running.erase(pid);
+        return true;
+    };
+
+    for (const ShardSpec& spec : shards) {
+        ShardSpec done;
+        std::string results;
+        std::vector<std::pair<int, int>> rows;
+        if (readManifest(manifestPath(dir, spec), done, results) && pointKey(done) == pointKey(spec)
+            && done.seedBegin == spec.seedBegin && done.seedEnd == spec.seedEnd
+            && readResults(fs::path(dir) / results, spec, rows)) { // completed by an earlier run, results intact
+            continue;
+        }
+        while (int(running.size()) >= procs) {
+            if (!reap()) {
+                break;
+            }
+        }
+
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) { // child: one shard, isolated from its siblings
+            _exit(runShard(spec, dir, memCapMB));
+        } else if (pid < 0) {
+            std::cerr << shardName(spec) << ": fork failed\n";
+            failed += 1;
+            continue;
+        }
+        running[pid] = spec;
+    }
+    while (!running.empty()) {
+        if (!reap()) {
+            break;
+        }
+    }
+    return failed;
+}
+
+bool mergeShards(const std::vector<ShardSpec>& plan, const std::string& dir, int N) {
+    std::map<PointKey, std::vector<std::pair<ShardSpec, std::string>>> points;
+    for (const ShardSpec& spec : plan) {
+        points[pointKey(spec)]; // listed even if none of its shards completed
+    }
+
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir, ec)) { // no directory: nothing completed
+        if (entry.path().extension() != ".manifest") {
+            continue;
+        }
+        ShardSpec spec;
+        std::string results;
+        auto point = points.end();
+        if (readManifest(entry.path(), spec, results) && (point = points.find(pointKey(spec))) != points.end()) {
+            point->second.push_back({spec, results}); // manifests of other configurations are ignored
+        }
+    }
+
+    bool complete = true;
+    for (auto& [key, shards] : points) {
+        std::sort(shards.begin(), shards.end(), [](const auto& a, const auto& b) {
+            return a.first.seedBegin < b.first.seedBegin;
+        });
+
+        auto [L, p, U, fC, fN] = key;
+        std::ostringstream label;
+        label << "L=" << L << " p=" << p << " U=" << U << " fC=" << fC << " fN=" << fN;
+
+        // coverage: complete shards must tile [0, N) without gaps or overlaps
+        bool covered = true;
+        int next = 0;
+        for (const auto& shard : shards) {
+            if (shard.first.seedBegin > next) {
+                std::cout << label.str() << ": missing seeds " << next << "-" << shard.first.seedBegin << '\n';
+                covered = false;
+            } else if (shard.first.seedBegin < next) {
+                std::cout << label.str() << ": overlapping shard " << shardName(shard.first) << '\n';
+                covered = false;
+            }
+            next = std::max(next, shard.first.seedEnd);
+        }
+        if (next < N) {
+            std::cout << label.str() << ": missing seeds " << next << "-" << N << '\n';
+            covered = false;
+        }
+        // results: every shard's file must hold exactly its seeds
+        std::vector<std::pair<int, int>> rows; // seed, lifetime
+        for (const auto& shard : shards) {
+            if (covered && !readResults(fs::path(dir) / shard.second, shard.first, rows)) {
+                std::cout << label.str() << ": results of " << shardName(shard.first) << " missing or incomplete\n";
+                covered = false;
+            }
+        }
+
+        fs::path mergedPath = fs::path(dir) / ("merged_" + pointName({L, p, U, fC, fN, 0, N}) + ".csv");
+        if (!covered) { // partial statistics would be biased toward the shards that survived
+            fs::remove(mergedPath, ec); // also drop the output of an earlier, complete merge
+            complete = false;
+            continue;
+        }
+
+        // combine statistics
+        std::ofstream merged(mergedPath, std::ios_base::out);
+        long n = 0;
+        double sum = 0;
+        double sqsum = 0;
+        for (const auto& [seed, count] : rows) {
+            merged << seed << "," << count << '\n';
+            n += 1;
+            sum += count;
+            sqsum += double(count)*count;
+        }
+        if (n > 0) {
+            double mu = sum / n;
+            double sd = std::sqrt(std::max(sqsum / n - mu*mu, 0.0));
+            std::cout << label.str() << ": n=" << n << " mu=" << mu << " sd=" << sd << " se=" << sd / std::sqrt(n) << '\n';
+        }
+    }
+    return complete;
+}
@@ -0,0 +1,35 @@
+#ifndef SHARD_H_
+#define SHARD_H_
+
+#include <string>
+#include <vector>
+
+// Sweep sharding across processes on one host. A shard runs the trials
+// with seeds [seedBegin, seedEnd) of one (L, p, U, fC, fN) point, writes
+// one lifetime per line and then a manifest marking the shard complete.
+// A shard is skipped when a manifest of exactly its spec exists; names
+// carry p, fC and fN so other configurations never collide.
+// mergeShards() checks that the complete shards of each planned point
+// cover the seeds [0, N) exactly once, and that their result files hold
+// exactly those seeds, then combines their statistics. Points that fail
+// the check get no combined output (an earlier one is removed).
+
+struct ShardSpec {
+    int L;
+    double p;
+    int U;
+    double fC;
+    double fN;
+    int seedBegin;
+    int seedEnd; // exclusive
+};
+
+std::string shardName(const ShardSpec& spec);
+std::vector<ShardSpec> planShards(const std::vector<int>& Ls, const std::vector<double>& ps,
+                                  int U, double fC, double fN, int N, int trialsPerShard); // trialsPerShard >= 1
+
+int runShard(const ShardSpec& spec, const std::string& dir, long memCapMB); // in this process, 0 on success
+int launchShards(const std::vector<ShardSpec>& shards, const std::string& dir, long memCapMB, int procs); // one child per shard, at most procs at a time, returns #failed
+bool mergeShards(const std::vector<ShardSpec>& plan, const std::string& dir, int N); // true if every planned point is covered
+
+#endif
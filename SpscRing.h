@@ -0,0 +1,79 @@
+#ifndef SPSCRING_H_
+#define SPSCRING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring of reusable slots.
+// The producer fills the slot returned by beginWrite() in place and
+// publishes it with commitWrite(); the consumer reads the slot returned
+// by beginRead() and hands it back with commitRead().
+template<typename T>
+class SpscRing {
+    private:
+        std::vector<T> slots;
+        size_t mask; // capacity-1, capacity is a power of 2
+
+        alignas(64) std::atomic<size_t> head{0}; // next slot to read
+        alignas(64) std::atomic<size_t> tail{0}; // next slot to write
+
+    public:
+        SpscRing(size_t capacity) {
+            size_t n = 1;
+            while (n < capacity) {
+                n <<= 1;
+            }
+            this->slots.resize(n);
+            this->mask = n-1;
+        }
+
+        T* beginWrite() { // nullptr if full
+            size_t t = this->tail.load(std::memory_order_relaxed);
+            if (t - this->head.load(std::memory_order_acquire) > this->mask) {
+                return nullptr;
+            }
+            return &this->slots[t & this->mask];
+        }
+
+        void commitWrite() {
+            this->tail.store(this->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        T* beginRead() { // nullptr if empty
+            size_t h = this->head.load(std::memory_order_relaxed);
+            if (h == this->tail.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            return &this->slots[h & this->mask];
+        }
+
+        void commitRead() {
+            this->head.store(this->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+};
+
+// Waiting on a full or empty ring: yield for a few rounds, then sleep with
+// doubling pauses of up to 1 ms, so the idle side does not hold a core
+// while the other side is slow. reset() after each successful access.
+class Backoff {
+    private:
+        int rounds = 0;
+
+    public:
+        void pause() {
+            if (this->rounds < 16) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(std::min(1000, 1 << std::min(this->rounds - 16, 10))));
+            }
+            this->rounds += 1;
+        }
+
+        void reset() { this->rounds = 0; }
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "Topology.h"
+#include "Location.h"
+
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <utility>
+
+Topology::Topology(int L, int Q) {
+    this->L = L;
+    this->Q = Q;
+
+    this->d = 0;
+    for (int Qd=1; Qd<L; Qd*=Q) {
+        this->d += 1;
+    }
+    int Qd = 1;
+    for (int k=0; k<this->d; k++) {
+        Qd *= Q;
+    }
+    assert(Qd == L); // assure L and Q are compatible
+
+    // toroidal wiring
+    this->neighbors.resize(8*L*L);
+    for (int i=0; i<L; i++) {
+        for (int j=0; j<L; j++) {
+            int i_ = (i-1 == -1) ? L-1 : i-1;
+            int j_ = (j-1 == -1) ? L-1 : j-1;
+            int ip = (i+1) % L;
+            int jp = (j+1) % L;
+
+            int* nb = &this->neighbors[8*(i*L + j)];
+            nb[Location::N]  = i_*L + j;
+            nb[Location::W]  = i*L + j_;
+            nb[Location::E]  = i*L + jp;
+            nb[Location::S]  = ip*L + j;
+            nb[Location::NW] = i_*L + j_;
+            nb[Location::NE] = i_*L + jp;
+            nb[Location::SW] = ip*L + j_;
+            nb[Location::SE] = ip*L + jp;
+        }
+    }
+
+    // k-level addresses: representatives are the centers of Q^k colonies
+    this->addr.resize(this->d*L*L);
+    this->reps.resize(this->d);
+    int Qk = 1;
+    for (int k=0; k<this->d; k++) {
+        int offset = (Qk - 1) / 2;
+        for (int i=0; i<L; i++) {
+            for (int j=0; j<L; j++) {
+                Location kaddr = Location::None;
+                if (i >= offset && j >= offset && (i - offset) % Qk == 0 && (j - offset) % Qk == 0) {
+                    kaddr = locFromCoords((i - offset) / Qk % Q, (j - offset) / Qk % Q);
+                    this->reps[k].push_back(i*L + j);
+                }
+                this->addr[k*L*L + i*L + j] = int8_t(kaddr);
+            }
+        }
+        Qk *= Q;
+    }
+}
+
+std::shared_ptr<const Topology> Topology::get(int L, int Q) {
+    static std::mutex mutex;
+    static std::map<std::pair<int,int>, std::weak_ptr<const Topology>> cache; // freed when unused
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const Topology> topo = cache[{L, Q}].lock();
+    if (!topo) {
+        topo = std::make_shared<const Topology>(L, Q);
+        cache[{L, Q}] = topo;
+    }
+    return topo;
+}
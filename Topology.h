@@ -0,0 +1,30 @@
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include "Location.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// (L,Q)-dependent lattice wiring, built once and shared read-only by all
+// CA/CoarseCA instances of the same size (see get()).
+struct Topology {
+
+    int L; // linear size of lattice
+    int Q; // colony size
+    int d; // hierarchy depth, L = Q^d
+
+    std::vector<int> neighbors; // per cell: 8 neighbor indices (N,W,E,S,NW,NE,SW,SE)
+    std::vector<int8_t> addr; // per level k<d and cell: k-level address, None if not a representative
+    std::vector<std::vector<int>> reps; // per level k<d: representative cells, row-major
+
+    const int* neighborsOf(int cell) const { return &this->neighbors[8*cell]; };
+    Location address(int k, int cell) const { return Location(this->addr[k*this->L*this->L + cell]); };
+
+    static std::shared_ptr<const Topology> get(int L, int Q); // cached per (L,Q)
+
+    Topology(int L, int Q);
+};
+
+#endif
@@ -8,12 +8,16 @@ ToricCode::ToricCode(int L) {
     this->L = L;
     this->qubits = new bool**[L];
     this->stabs = new bool*[L];
+    this->qubitData = new bool[2*L*L]; // contiguous row-major (L,L,2)
+    this->stabData = new bool[L*L]; // contiguous row-major (L,L)
+    this->rowParities = new bool[L];
+    this->colParities = new bool[L];
 
     for (int i=0; i<L; i++) {
         this->qubits[i] = new bool*[L];
-        this->stabs[i] = new bool[L];
+        this->stabs[i] = &this->stabData[i*L];
         for (int j=0; j<L; j++) {
-            this->qubits[i][j] = new bool[2]; // (N,W)-unit cell
+            this->qubits[i][j] = &this->qubitData[2*(i*L + j)]; // (N,W)-unit cell
         }
     }
     
@@ -22,15 +26,23 @@ ToricCode::ToricCode(int L) {
 
 ToricCode::~ToricCode() {
     for (int i = 0; i<this->L; i++) {
-        delete[] this->stabs[i];
-        for (int j=0; j<this->L; j++) {
-            delete[] this->qubits[i][j];
-        }
+        delete[] this->qubits[i];
     }
+    delete[] this->qubits;
+    delete[] this->stabs;
+    delete[] this->qubitData;
+    delete[] this->stabData;
+    delete[] this->rowParities;
+    delete[] this->colParities;
 }
 
 void ToricCode::reset() {
+    this->oddRows = 0;
+    this->oddCols = 0;
+
     for(int i = 0; i < L; i++){
+        this->rowParities[i] = 0;
+        this->colParities[i] = 0;
 		for(int j = 0; j < L; j++){
             this->stabs[i][j] = 0;
             this->qubits[i][j][0] = 0;
@@ -50,12 +62,7 @@ bool ToricCode::getStab(int i, int j) { // plaquette operator
     return ret;
 }
 
-bool** ToricCode::getSyndromes() {
-    for (int i = 0; i<this->L; i++) {
-        for (int j = 0; j<this->L; j++) {
-            this->stabs[i][j] = this->getStab(i,j);
-        }
-    }
+bool** ToricCode::getSyndromes() { // maintained incrementally by toggle()
     return this->stabs;
 }
 
@@ -69,48 +76,71 @@ void ToricCode::noise(double p) {
             for (int k=0; k<2; k++) {
                 double r = this->randDist(this->randGen);
                 if(r <= p) {
-                    this->qubits[i][j][k] ^= 1;
+                    this->toggle(i,j,k);
+                }
+            }
+        }
+    }
+}
+
+void ToricCode::noise(double p, const std::vector<double>& uniforms) {
+    for (int i = 0; i<this->L; i++) {
+        for (int j = 0; j<this->L; j++) {
+            for (int k=0; k<2; k++) {
+                if(uniforms[2*(i*this->L + j) + k] <= p) {
+                    this->toggle(i,j,k);
                 }
             }
         }
     }
 }
 
+void ToricCode::applyFlips(const std::vector<int>& flips) {
+    for (int q : flips) {
+        this->toggle(q / (2*this->L), (q/2) % this->L, q % 2);
+    }
+}
+
+void ToricCode::toggle(int i, int j, int k) {
+    this->qubits[i][j][k] ^= 1;
+    this->stabs[i][j] ^= 1; // N or W edge of own plaquette
+
+    if (k == 0) { // N edge = S edge of plaquette above
+        this->stabs[(i-1+this->L)%this->L][j] ^= 1;
+        this->rowParities[i] ^= 1;
+        this->oddRows += this->rowParities[i] ? 1 : -1;
+    } else { // W edge = E edge of plaquette to the left
+        this->stabs[i][(j-1+this->L)%this->L] ^= 1;
+        this->colParities[j] ^= 1;
+        this->oddCols += this->colParities[j] ? 1 : -1;
+    }
+}
+
 void ToricCode::flip(int i, int j, int loc) {
 
     switch(loc) {
         case Location::N: 
-            this->qubits[i][j][0] ^= 1;
+            this->toggle(i,j,0);
             break;
         case Location::W:
-            this->qubits[i][j][1] ^= 1;
+            this->toggle(i,j,1);
             break;
         case Location::E:
-            this->qubits[i][(j+1)%this->L][1] ^= 1;
+            this->toggle(i,(j+1)%this->L,1);
             break;
         case Location::S:
-            this->qubits[(i+1)%this->L][j][0] ^= 1;
+            this->toggle((i+1)%this->L,j,0);
             break;
     }
 }
 
-bool ToricCode::hasLogErr() {
-    int paritySumRows = 0;
-    int paritySumCols = 0;
-
-    for(int i=0; i<this->L; i++) {
-        bool parityRows = 0;
-        bool parityCols = 0;
-
-        for(int j=0; j<this->L; j++) {
-            parityRows ^= this->qubits[i][j][0];
-            parityCols ^= this->qubits[j][i][1];
-        }
-        
-        paritySumRows += int(parityRows);
-        paritySumCols += int(parityCols);
+void ToricCode::applyCorrections(const std::vector<Correction>& corrections) {
+    for (const Correction& c : corrections) {
+        this->flip(c.row, c.col, c.dir);
     }
-    
-    return (paritySumRows > this->L/2) || (paritySumCols > this->L/2);
+}
+
+bool ToricCode::hasLogErr() {
+    return (this->oddRows > this->L/2) || (this->oddCols > this->L/2);
 }
 
@@ -1,28 +1,45 @@
 #ifndef TORICCODE_H_
 #define TORICCODE_H_
 
+#include "Correction.h"
+
 #include <random>
+#include <vector>
 
 class ToricCode {
     private:
         int L;
         bool*** qubits;
-        bool** stabs;
+        bool** stabs; // kept in sync with qubits on every flip
+        bool* qubitData; // backing storage of qubits
+        bool* stabData; // backing storage of stabs
+        bool* rowParities; // parity of N qubits per row
+        bool* colParities; // parity of W qubits per column
+        int oddRows;
+        int oddCols;
 
         std::random_device randDev; // wraps /dev/urandom
         std::mt19937 randGen{randDev()}; // init w/ random seed
         std::uniform_real_distribution<double> randDist;
 
+        void toggle(int i, int j, int k); // flip qubit, update stabs and parities
+
     public:
         ToricCode(int L);
         virtual ~ToricCode();
         void reset();
         void flip(int i, int j, int dir);
+        void applyCorrections(const std::vector<Correction>& corrections);
         bool getStab(int i, int j);
         bool** getSyndromes();
         bool getQubit(int i, int j, int k);
+        bool* getQubitData() { return this->qubitData; }; // (L,L,2) row-major
+        bool* getStabData() { return this->stabData; }; // (L,L) row-major
+        int getL() { return this->L; };
         bool hasLogErr();
         void noise(double p);
+        void noise(double p, const std::vector<double>& uniforms); // flip qubit q if uniforms[q] <= p
+        void applyFlips(const std::vector<int>& flips); // flip qubits q = 2*(i*L+j)+k
         void setSeed(int seed) { this->randGen.seed(seed); };
 };
 
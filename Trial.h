@@ -0,0 +1,36 @@
+#ifndef TRIAL_H_
+#define TRIAL_H_
+
+#include "ToricCode.h"
+
+// Decoding trials for any engine with reset(), step(bool** syndromes) and
+// getCorrectionList(), i.e. CA or CoarseCA.
+
+template<class Engine>
+void decodeStep(ToricCode& tc, Engine& ca) { // current syndromes -> engine -> corrections
+    ca.step(tc.getSyndromes());
+    tc.applyCorrections(ca.getCorrectionList());
+}
+
+// Steps until a logical error, starting from a clean code. noise(tc) adds
+// one round of errors, e.g. from a pre-generated batch.
+template<class Engine, class Noise>
+int lifetime(ToricCode& tc, Engine& ca, Noise noise) {
+    tc.reset();
+    ca.reset();
+
+    int count = 0;
+    while(!tc.hasLogErr()) {
+        noise(tc);
+        decodeStep(tc, ca);
+        count += 1;
+    }
+    return count;
+}
+
+template<class Engine>
+int lifetime(ToricCode& tc, Engine& ca, double p) { // iid qubit flips with probability p
+    return lifetime(tc, ca, [p](ToricCode& t) { t.noise(p); });
+}
+
+#endif
@@ -1,6 +1,11 @@
 #include "Location.h"
 #include "ToricCode.h"
 #include "CA.h"
+#include "CoarseCA.h"
+#include "Harness.h"
+#include "SpscRing.h"
+#include "Shard.h"
+#include "Trial.h"
 
 #include <iostream>
 #include <vector>
@@ -8,6 +13,11 @@
 #include <chrono>
 #include <stdexcept>
 #include <fstream>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <atomic>
 
 class Timer {
     using clk = std::chrono::steady_clock;
@@ -49,14 +59,6 @@ double sd(std::vector<int> &counts, int N) {
     return std::sqrt( sqDistSum / N );
 }
 
-void applyCorrections(ToricCode& tc, Location** corrections, int L) {
-    for (int i=0; i<L; i++) {
-        for (int j=0; j<L; j++) {
-            tc.flip(i,j,corrections[i][j]);
-        }
-    }
-}
-
 double harringtonVis(ToricCode &tc, CA &ca, double p, int N, int L) {
     std::ofstream qubits_file;
     std::ofstream flips_file;
@@ -84,17 +86,20 @@ double harringtonVis(ToricCode &tc, CA &ca, double p, int N, int L) {
         qubits_file << std::endl;
 
         bool** syndromes = tc.getSyndromes();
-        Location** corrections = ca.step(syndromes);
+        ca.step(syndromes);
 
         // signals
         for(int j=0; j<L; j++){
             for(int k=0; k<L; k++) {
                 int n_counts = 0;
-                for(int l=0; l<8; l++) {
-                    if(ca.getCell(j,k)->getMemory(0)->flipSig[l]) { // TODO: include flipSigs on all levels.
+                Memory* mem = ca.getCell(j,k)->getMemory(0);
+                for(int l=0; l<4; l++) {
+                    if((mem->flipSig >> l) & 1) { // TODO: include flipSigs on all levels.
                         flips_file << j << "," << k << "," << l << " ";
                     }
-                    n_counts += ca.getCell(j,k)->getMemory(0)->countSig[l];
+                }
+                for(int l=0; l<8; l++) {
+                    n_counts += (mem->countSig >> l) & 1;
                 }
                 if(n_counts > 0) {
                     counts_file << j << "," << k << "," << 0 << " ";
@@ -105,43 +110,191 @@ double harringtonVis(ToricCode &tc, CA &ca, double p, int N, int L) {
         flips_file << std::endl;
         counts_file << std::endl;
 
-        applyCorrections(tc, corrections, L);
+        tc.applyCorrections(ca.getCorrectionList());
 
     }
     return 0.0;
 }
 
-double benchmarkHarrington(ToricCode &tc, CA &ca, double p, int N, int L) {
+// Lifetimes go to ./data/<mode>L=.._p=...csv; mode is "" for the faithful
+// engine and e.g. "coarse_" otherwise, so engines never share a file.
+template<class Engine> // CA or CoarseCA
+double benchmarkHarrington(ToricCode &tc, Engine &ca, double p, int N, int L, const std::string &mode = "") {
 
     std::ofstream counts_file;
-    counts_file.open("./data/L=" + std::to_string(L) + "_p=" + std::to_string(int(1/p)) + ".csv", std::ios_base::app); // append
+    counts_file.open("./data/" + mode + "L=" + std::to_string(L) + "_p=" + std::to_string(int(1/p)) + ".csv", std::ios_base::app); // append
 
     int tot_count = 0;
 
     for(int n=0; n<N; n++) {
-        tc.reset();
-        ca.reset();
-
-        int count = 0;
+        int count = lifetime(tc, ca, p);
+        counts_file << std::to_string(count) << std::endl;
+        tot_count += count;
+    }
+    return tot_count;
+}
 
-        while(!tc.hasLogErr()) {
-            tc.noise(p);
-            bool** syndromes = tc.getSyndromes();
-            Location** corrections = ca.step(syndromes);
+// Same as benchmarkHarrington, but noise is generated on a producer thread
+// as batches of qubit flips and handed to the decoder through an SPSC ring.
+double benchmarkPipelined(ToricCode &tc, CA &ca, double p, int N, int L) {
 
-            applyCorrections(tc, corrections, L);
+    std::ofstream counts_file;
+    counts_file.open("./data/pipelined_L=" + std::to_string(L) + "_p=" + std::to_string(int(1/p)) + ".csv", std::ios_base::app); // append
+
+    SpscRing<std::vector<int>> ring(64); // flip batches, one per time step
+    std::atomic<bool> done{false};
+
+    std::thread producer([&ring, &done, p, L]() {
+        std::random_device randDev;
+        std::mt19937 randGen{randDev()};
+        std::uniform_real_distribution<double> randDist;
+        Backoff backoff;
+
+        while (!done.load(std::memory_order_relaxed)) {
+            std::vector<int>* flips = ring.beginWrite();
+            if (flips == nullptr) { // ring full: the decoder is the slow side
+                backoff.pause();
+                continue;
+            }
+            backoff.reset();
+            flips->clear();
+            for (int q=0; q<2*L*L; q++) {
+                if (randDist(randGen) <= p) {
+                    flips->push_back(q);
+                }
+            }
+            ring.commitWrite();
+        }
+    });
 
-            count += 1;
+    auto consume = [&ring](ToricCode &t) { // next batch of flips from the producer
+        std::vector<int>* flips;
+        Backoff backoff;
+        while ((flips = ring.beginRead()) == nullptr) { // ring empty
+            backoff.pause();
         }
+        t.applyFlips(*flips);
+        ring.commitRead();
+    };
+
+    int tot_count = 0;
+
+    for(int n=0; n<N; n++) {
+        int count = lifetime(tc, ca, consume);
         counts_file << std::to_string(count) << std::endl;
         tot_count += count;
     }
+
+    done.store(true, std::memory_order_relaxed);
+    producer.join();
+
     return tot_count;
 }
 
+struct DecoderParams {
+    int U;
+    double fC;
+    double fN;
+};
+
+// Common random numbers: one stream of per-qubit uniforms drives every p
+// (monotone thresholding) and every decoder configuration. Lifetimes of a
+// trial are written as one row, so configurations can be compared pairwise.
+std::vector<int> benchmarkCoupled(std::vector<double> &ps, std::vector<DecoderParams> &params, int N, int L) {
+
+    int nP = ps.size();
+    int nC = params.size();
+
+    std::ofstream counts_file;
+    counts_file.open("./data/coupled_L=" + std::to_string(L) + ".csv", std::ios_base::app); // append
+
+    std::vector<ToricCode*> tcs; // index: i*nC + c
+    std::vector<CA*> cas;
+    for (int i=0; i<nP; i++) {
+        for (int c=0; c<nC; c++) {
+            tcs.push_back(new ToricCode(L));
+            cas.push_back(new CA(L, params[c].U, params[c].fC, params[c].fN));
+        }
+    }
+
+    std::random_device randDev;
+    std::mt19937 randGen{randDev()};
+    std::uniform_real_distribution<double> randDist;
+    std::vector<double> uniforms(2*L*L);
+
+    std::vector<int> tot_counts(nP*nC, 0);
+    std::vector<double> diff_sum(nP*nC, 0); // paired difference to config 0
+    std::vector<double> diff_sqsum(nP*nC, 0);
+
+    for (int n=0; n<N; n++) {
+        std::vector<int> counts(nP*nC, 0);
+        std::vector<bool> alive(nP*nC, true);
+        int n_alive = nP*nC;
+
+        for (int m=0; m<nP*nC; m++) {
+            tcs[m]->reset();
+            cas[m]->reset();
+        }
+
+        while (n_alive > 0) {
+            for (double& r : uniforms) {
+                r = randDist(randGen); // drawn once, shared by all pairs
+            }
+
+            for (int i=0; i<nP; i++) {
+                for (int c=0; c<nC; c++) {
+                    int m = i*nC + c;
+                    if (!alive[m]) {
+                        continue;
+                    }
+
+                    tcs[m]->noise(ps[i], uniforms);
+                    decodeStep(*tcs[m], *cas[m]);
+                    counts[m] += 1;
+
+                    if (tcs[m]->hasLogErr()) {
+                        alive[m] = false;
+                        n_alive -= 1;
+                    }
+                }
+            }
+        }
+
+        for (int m=0; m<nP*nC; m++) {
+            counts_file << counts[m] << ((m+1 < nP*nC) ? "," : "\n");
+            tot_counts[m] += counts[m];
+
+            double diff = counts[m] - counts[(m/nC)*nC]; // same p, config 0
+            diff_sum[m] += diff;
+            diff_sqsum[m] += diff*diff;
+        }
+    }
+
+    for (int i=0; i<nP; i++) {
+        for (int c=1; c<nC; c++) {
+            int m = i*nC + c;
+            double mu = diff_sum[m] / N;
+            double var = diff_sqsum[m] / N - mu*mu;
+            std::cout << "p=" << ps[i] << " (U=" << params[c].U << ",fC=" << params[c].fC << ",fN=" << params[c].fN
+                      << ") - (U=" << params[0].U << ",fC=" << params[0].fC << ",fN=" << params[0].fN
+                      << "): mu=" << mu << " +- " << std::sqrt(std::max(var, 0.0) / N) << '\n';
+        }
+    }
+
+    for (int m=0; m<nP*nC; m++) {
+        delete tcs[m];
+        delete cas[m];
+    }
+    return tot_counts;
+}
+
 // main loop //
 
-int main() {
+int main(int argc, char** argv) {
+
+    if (argc > 1 && std::string(argv[1]) == "harness") { // golden traces + differential fuzzing; "harness record" rewrites the goldens
+        return runHarness(500, 3, argc > 2 && std::string(argv[2]) == "record") ? 0 : 1;
+    }
 
     // Q=3 (hard-coded)
     int U = 10;
@@ -154,7 +307,32 @@ int main() {
     // std::vector<double> ps = {11,12,14,16,25,33,50,111,125,142,166,250};
     std::vector<double> ps = {3e-3};
 
-
+    // decoder configurations compared in coupled mode (first is the reference)
+    std::vector<DecoderParams> params = {{U,fC,fN}, {U,8/10.,3/10.}, {2*U,fC,fN}};
+    bool coupled = argc > 1 && std::string(argv[1]) == "coupled";
+    bool pipelined = argc > 1 && std::string(argv[1]) == "pipelined"; // noise on a producer thread
+    bool coarse = argc > 1 && std::string(argv[1]) == "coarse"; // abstracted hierarchy (CoarseCA)
+
+    // sharded sweeps: one process per (L, p, seed range), see Shard.h
+    std::string shardDir = "./data/shards";
+    if (argc > 5 && std::string(argv[1]) == "shard") { // shard L p seedBegin seedEnd [memMB]
+        ShardSpec spec = {std::stoi(argv[2]), std::stod(argv[3]), U, fC, fN, std::stoi(argv[4]), std::stoi(argv[5])};
+        return runShard(spec, shardDir, argc > 6 ? std::stol(argv[6]) : 0);
+    }
+    if (argc > 3 && std::string(argv[1]) == "sweep") { // sweep trialsPerShard procs [memMB]
+        int trialsPerShard = std::stoi(argv[2]);
+        int procs = std::stoi(argv[3]);
+        if (trialsPerShard < 1 || procs < 1) {
+            std::cerr << "sweep: trialsPerShard and procs must be at least 1\n";
+            return 1;
+        }
+        std::vector<ShardSpec> shards = planShards(Ls, ps, U, fC, fN, N, trialsPerShard);
+        int failed = launchShards(shards, shardDir, argc > 4 ? std::stol(argv[4]) : 0, procs);
+        return (mergeShards(shards, shardDir, N) && failed == 0) ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "merge") {
+        return mergeShards(planShards(Ls, ps, U, fC, fN, N, N), shardDir, N) ? 0 : 1; // planned points, shard size irrelevant
+    }
 
     Timer timer;
     timer.start();
@@ -162,13 +340,37 @@ int main() {
     for(int L : Ls) {
 
         std::cout << "--- Lattice size " << L << " ---\n";
+
+        if (coupled) {
+            std::vector<int> counts = benchmarkCoupled(ps, params, N, L);
+            for(size_t i=0; i<ps.size(); i++) {
+                for(size_t c=0; c<params.size(); c++) {
+                    std::cout << "p=" << ps[i] << " U=" << params[c].U << " fC=" << params[c].fC << " fN=" << params[c].fN
+                              << ": mu=" << static_cast<double>(counts[i*params.size() + c]) / N << '\n';
+                }
+            }
+            continue;
+        }
+
         std::vector<int> counts(ps.size(), 0);
 
         ToricCode tc(L);
+
+        if (coarse) {
+            CoarseCA cca(L,U,fC,fN);
+            for(size_t i=0; i<ps.size(); i++) {
+                counts[i] = benchmarkHarrington(tc, cca, ps[i], N, L, "coarse_");
+            }
+            for(size_t i=0; i<ps.size(); i++) {
+                std::cout << "p=" << ps[i] << ": mu=" << static_cast<double>(counts[i]) / N << '\n';
+            }
+            continue;
+        }
+
         CA ca(L,U,fC,fN);
 
         for(int i=0; i<ps.size(); i++) {
-            counts[i] = benchmarkHarrington(tc, ca, ps[i], N, L);
+            counts[i] = pipelined ? benchmarkPipelined(tc, ca, ps[i], N, L) : benchmarkHarrington(tc, ca, ps[i], N, L);
             // counts[i] = benchmarkToricCode(tc, ps[i], N);
             // counts[i] = harringtonVis(tc, ca, ps[i], N, L);
         }
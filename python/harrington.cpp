@@ -0,0 +1,530 @@
+// Python bindings for ToricCode and CA (CPython and NumPy C API).
+//
+// Lattice state is exposed as read-only NumPy views on the C++ buffers (no
+// copies); views keep their owning object alive. Qubits change only through
+// noise/flip/apply_flips and CA.step, which keep syndromes and parities in
+// sync. Build and test from this directory with
+//
+//   python3 setup.py build_ext --inplace && python3 test_harrington.py
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+#include "../Location.h"
+#include "../Memory.h"
+#include "../ToricCode.h"
+#include "../CA.h"
+#include "../Trial.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct PyToricCode {
+    PyObject_HEAD
+    ToricCode* tc;
+};
+
+struct PyCA {
+    PyObject_HEAD
+    CA* ca;
+};
+
+PyTypeObject* ToricCodeType;
+PyTypeObject* CAType;
+
+PyCFunction withKeywords(PyCFunctionWithKeywords f) {
+    return reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(f));
+}
+
+// Read-only view on memory owned by owner.
+PyObject* view(PyObject* owner, int typenum, int nd, npy_intp* dims, npy_intp* strides, const void* data) {
+    PyObject* arr = PyArray_New(&PyArray_Type, nd, dims, typenum, strides, const_cast<void*>(data), 0, 0, nullptr);
+    if (arr == nullptr) {
+        return nullptr;
+    }
+    PyArray_CLEARFLAGS(reinterpret_cast<PyArrayObject*>(arr), NPY_ARRAY_WRITEABLE);
+    Py_INCREF(owner);
+    if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(arr), owner) < 0) { // steals owner
+        Py_DECREF(arr);
+        return nullptr;
+    }
+    return arr;
+}
+
+// CA asserts these; raise instead of aborting the interpreter.
+bool checkParams(int L, int U) {
+    int Qd = 3;
+    while (Qd < L) {
+        Qd *= 3;
+    }
+    if (L < 3 || Qd != L) {
+        PyErr_SetString(PyExc_ValueError, "L must be a power of 3");
+        return false;
+    }
+    if (U <= 3) {
+        PyErr_SetString(PyExc_ValueError, "U must exceed the colony size 3");
+        return false;
+    }
+    return true;
+}
+
+// ToricCode
+
+PyObject* ToricCode_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"L", nullptr};
+    int L;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i", const_cast<char**>(kwlist), &L)) {
+        return nullptr;
+    }
+    if (L < 1) {
+        PyErr_SetString(PyExc_ValueError, "L must be positive");
+        return nullptr;
+    }
+    PyToricCode* self = reinterpret_cast<PyToricCode*>(type->tp_alloc(type, 0));
+    if (self == nullptr) {
+        return nullptr;
+    }
+    try {
+        self->tc = new ToricCode(L);
+    } catch (const std::bad_alloc&) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+void ToricCode_dealloc(PyObject* obj) {
+    PyTypeObject* type = Py_TYPE(obj);
+    delete reinterpret_cast<PyToricCode*>(obj)->tc;
+    type->tp_free(obj);
+    Py_DECREF(type);
+}
+
+ToricCode& toricCode(PyObject* self) {
+    return *reinterpret_cast<PyToricCode*>(self)->tc;
+}
+
+PyObject* ToricCode_reset(PyObject* self, PyObject*) {
+    toricCode(self).reset();
+    Py_RETURN_NONE;
+}
+
+PyObject* ToricCode_noise(PyObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"p", nullptr};
+    double p;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "d", const_cast<char**>(kwlist), &p)) {
+        return nullptr;
+    }
+    toricCode(self).noise(p);
+    Py_RETURN_NONE;
+}
+
+PyObject* ToricCode_flip(PyObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"i", "j", "dir", nullptr};
+    int i, j, dir;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iii", const_cast<char**>(kwlist), &i, &j, &dir)) {
+        return nullptr;
+    }
+    ToricCode& tc = toricCode(self);
+    if (i < 0 || i >= tc.getL() || j < 0 || j >= tc.getL()) {
+        PyErr_SetString(PyExc_IndexError, "plaquette out of range");
+        return nullptr;
+    }
+    if (dir != Location::N && dir != Location::W && dir != Location::E && dir != Location::S) {
+        PyErr_SetString(PyExc_ValueError, "dir must be N, W, E or S");
+        return nullptr;
+    }
+    tc.flip(i, j, dir);
+    Py_RETURN_NONE;
+}
+
+PyObject* ToricCode_applyFlips(PyObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"flips", nullptr};
+    PyObject* obj;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", const_cast<char**>(kwlist), &obj)) {
+        return nullptr;
+    }
+    PyArrayObject* in = reinterpret_cast<PyArrayObject*>(PyArray_FROM_O(obj));
+    if (in == nullptr) {
+        return nullptr;
+    }
+    if (PyArray_SIZE(in) > 0 && !PyArray_ISINTEGER(in)) {
+        Py_DECREF(in);
+        PyErr_SetString(PyExc_TypeError, "flips must be integers");
+        return nullptr;
+    }
+    PyArrayObject* arr = reinterpret_cast<PyArrayObject*>(PyArray_FROMANY(reinterpret_cast<PyObject*>(in), NPY_INTP, 1, 1,
+                                                                          NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST));
+    Py_DECREF(in);
+    if (arr == nullptr) {
+        return nullptr;
+    }
+    ToricCode& tc = toricCode(self);
+    const npy_intp* q = static_cast<const npy_intp*>(PyArray_DATA(arr));
+    std::vector<int> flips;
+    for (npy_intp n=0; n<PyArray_SIZE(arr); n++) { // all or nothing
+        if (q[n] < 0 || q[n] >= 2*tc.getL()*tc.getL()) {
+            Py_DECREF(arr);
+            PyErr_SetString(PyExc_IndexError, "qubit out of range");
+            return nullptr;
+        }
+        flips.push_back(int(q[n]));
+    }
+    Py_DECREF(arr);
+    tc.applyFlips(flips);
+    Py_RETURN_NONE;
+}
+
+PyObject* ToricCode_hasLogErr(PyObject* self, PyObject*) {
+    return PyBool_FromLong(toricCode(self).hasLogErr());
+}
+
+PyObject* ToricCode_setSeed(PyObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"seed", nullptr};
+    int seed;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i", const_cast<char**>(kwlist), &seed)) {
+        return nullptr;
+    }
+    toricCode(self).setSeed(seed);
+    Py_RETURN_NONE;
+}
+
+PyObject* ToricCode_getL(PyObject* self, void*) {
+    return PyLong_FromLong(toricCode(self).getL());
+}
+
+PyObject* ToricCode_getQubits(PyObject* self, void*) { // (L,L,2): N,W qubit per plaquette
+    ToricCode& tc = toricCode(self);
+    npy_intp dims[3] = {tc.getL(), tc.getL(), 2};
+    return view(self, NPY_BOOL, 3, dims, nullptr, tc.getQubitData());
+}
+
+PyObject* ToricCode_getSyndromes(PyObject* self, void*) { // (L,L)
+    ToricCode& tc = toricCode(self);
+    npy_intp dims[2] = {tc.getL(), tc.getL()};
+    return view(self, NPY_BOOL, 2, dims, nullptr, tc.getStabData());
+}
+
+PyMethodDef ToricCode_methods[] = {
+    {"reset", ToricCode_reset, METH_NOARGS, "Clear all qubits."},
+    {"noise", withKeywords(ToricCode_noise), METH_VARARGS | METH_KEYWORDS, "Flip every qubit with probability p."},
+    {"flip", withKeywords(ToricCode_flip), METH_VARARGS | METH_KEYWORDS, "Flip the dir (N, W, E or S) edge of plaquette (i, j)."},
+    {"apply_flips", withKeywords(ToricCode_applyFlips), METH_VARARGS | METH_KEYWORDS, "Flip qubits q = 2*(i*L+j)+k (k=0: N, k=1: W)."},
+    {"has_log_err", ToricCode_hasLogErr, METH_NOARGS, "True if the qubits hold a logical error."},
+    {"set_seed", withKeywords(ToricCode_setSeed), METH_VARARGS | METH_KEYWORDS, "Seed the noise generator."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyGetSetDef ToricCode_getset[] = {
+    {"L", ToricCode_getL, nullptr, "Linear size of the lattice.", nullptr},
+    {"qubits", ToricCode_getQubits, nullptr, "Read-only (L,L,2) view: N,W qubit per plaquette.", nullptr},
+    {"syndromes", ToricCode_getSyndromes, nullptr, "Read-only (L,L) view of the plaquette syndromes.", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+PyType_Slot ToricCode_slots[] = {
+    {Py_tp_new, reinterpret_cast<void*>(ToricCode_new)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(ToricCode_dealloc)},
+    {Py_tp_methods, ToricCode_methods},
+    {Py_tp_getset, ToricCode_getset},
+    {Py_tp_doc, const_cast<char*>("ToricCode(L): toric code on an L x L lattice")},
+    {0, nullptr}
+};
+
+PyType_Spec ToricCode_spec = {"harrington.ToricCode", sizeof(PyToricCode), 0, Py_TPFLAGS_DEFAULT, ToricCode_slots};
+
+// CA
+
+PyObject* CA_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"L", "U", "fC", "fN", nullptr};
+    int L, U;
+    double fC, fN;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iidd", const_cast<char**>(kwlist), &L, &U, &fC, &fN)) {
+        return nullptr;
+    }
+    if (!checkParams(L, U)) {
+        return nullptr;
+    }
+    PyCA* self = reinterpret_cast<PyCA*>(type->tp_alloc(type, 0));
+    if (self == nullptr) {
+        return nullptr;
+    }
+    try {
+        self->ca = new CA(L, U, fC, fN);
+    } catch (const std::bad_alloc&) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+void CA_dealloc(PyObject* obj) {
+    PyTypeObject* type = Py_TYPE(obj);
+    delete reinterpret_cast<PyCA*>(obj)->ca;
+    type->tp_free(obj);
+    Py_DECREF(type);
+}
+
+CA& cellularAutomaton(PyObject* self) {
+    return *reinterpret_cast<PyCA*>(self)->ca;
+}
+
+Level* level(CA& ca, int k) {
+    if (k < 0 || k >= ca.getDepth()-1) {
+        PyErr_SetString(PyExc_IndexError, "level out of range");
+        return nullptr;
+    }
+    return &ca.getLevel(k);
+}
+
+bool parseLevel(PyObject* args, PyObject* kwds, int& k) {
+    static const char* kwlist[] = {"k", nullptr};
+    return PyArg_ParseTupleAndKeywords(args, kwds, "i", const_cast<char**>(kwlist), &k);
+}
+
+PyObject* CA_reset(PyObject* self, PyObject*) {
+    cellularAutomaton(self).reset();
+    Py_RETURN_NONE;
+}
+
+PyObject* CA_step(PyObject* self, PyObject* args, PyObject* kwds) { // returns (n,3) array of (row, col, dir)
+    static const char* kwlist[] = {"tc", "apply", nullptr};
+    PyObject* obj;
+    int apply = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|p", const_cast<char**>(kwlist), ToricCodeType, &obj, &apply)) {
+        return nullptr;
+    }
+    CA& ca = cellularAutomaton(self);
+    ToricCode& tc = toricCode(obj);
+    if (tc.getL() != ca.getL()) {
+        PyErr_SetString(PyExc_ValueError, "lattice sizes differ");
+        return nullptr;
+    }
+
+    ca.step(tc.getSyndromes());
+    const std::vector<Correction>& corrections = ca.getCorrectionList();
+    if (apply) {
+        tc.applyCorrections(corrections);
+    }
+
+    npy_intp dims[2] = {npy_intp(corrections.size()), 3};
+    PyObject* out = PyArray_SimpleNew(2, dims, NPY_INT);
+    if (out == nullptr) {
+        return nullptr;
+    }
+    int* o = static_cast<int*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(out)));
+    for (const Correction& c : corrections) {
+        *o++ = c.row;
+        *o++ = c.col;
+        *o++ = c.dir;
+    }
+    return out;
+}
+
+PyObject* levelView(PyObject* self, PyObject* args, PyObject* kwds, size_t member) { // (L,L) view on one Memory bitmask
+    int k;
+    if (!parseLevel(args, kwds, k)) {
+        return nullptr;
+    }
+    CA& ca = cellularAutomaton(self);
+    Level* lvl = level(ca, k);
+    if (lvl == nullptr) {
+        return nullptr;
+    }
+    npy_intp dims[2] = {ca.getL(), ca.getL()};
+    npy_intp strides[2] = {npy_intp(ca.getL()*sizeof(Memory)), npy_intp(sizeof(Memory))};
+    return view(self, NPY_UINT8, 2, dims, strides, reinterpret_cast<uint8_t*>(lvl->cells.data()) + member);
+}
+
+PyObject* CA_countSig(PyObject* self, PyObject* args, PyObject* kwds) {
+    return levelView(self, args, kwds, offsetof(Memory, countSig));
+}
+
+PyObject* CA_flipSig(PyObject* self, PyObject* args, PyObject* kwds) {
+    return levelView(self, args, kwds, offsetof(Memory, flipSig));
+}
+
+PyObject* CA_count(PyObject* self, PyObject* args, PyObject* kwds) { // (n,9) counts of the representatives
+    int k;
+    if (!parseLevel(args, kwds, k)) {
+        return nullptr;
+    }
+    Level* lvl = level(cellularAutomaton(self), k);
+    if (lvl == nullptr) {
+        return nullptr;
+    }
+    int width = lvl->count.getWidth();
+    npy_intp dims[2] = {lvl->n*lvl->n, 9};
+    return view(self, (width == 1) ? NPY_UINT8 : (width == 2) ? NPY_UINT16 : NPY_UINT32, 2, dims, nullptr, lvl->count.data());
+}
+
+PyObject* CA_reps(PyObject* self, PyObject* args, PyObject* kwds) { // (n,) cell indices of the representatives
+    int k;
+    if (!parseLevel(args, kwds, k)) {
+        return nullptr;
+    }
+    CA& ca = cellularAutomaton(self);
+    if (level(ca, k) == nullptr) {
+        return nullptr;
+    }
+    const std::vector<int>& reps = ca.getTopology().reps[k+1]; // shared by all CAs of this L
+    npy_intp dims[1] = {npy_intp(reps.size())};
+    return view(self, NPY_INT, 1, dims, nullptr, reps.data());
+}
+
+PyObject* CA_getL(PyObject* self, void*) {
+    return PyLong_FromLong(cellularAutomaton(self).getL());
+}
+
+PyObject* CA_getDepth(PyObject* self, void*) {
+    return PyLong_FromLong(cellularAutomaton(self).getDepth());
+}
+
+PyMethodDef CA_methods[] = {
+    {"reset", CA_reset, METH_NOARGS, "Clear all cell memories."},
+    {"step", withKeywords(CA_step), METH_VARARGS | METH_KEYWORDS,
+     "step(tc, apply=True): one time step on tc's syndromes; returns the (n,3) corrections (row, col, dir)."},
+    {"count_sig", withKeywords(CA_countSig), METH_VARARGS | METH_KEYWORDS,
+     "Read-only (L,L) view of level-k count signal bits N,W,E,S,NW,NE,SW,SE."},
+    {"flip_sig", withKeywords(CA_flipSig), METH_VARARGS | METH_KEYWORDS,
+     "Read-only (L,L) view of level-k flip signal bits N,W,E,S."},
+    {"count", withKeywords(CA_count), METH_VARARGS | METH_KEYWORDS,
+     "Read-only (n,9) view of level-k counts of the representatives."},
+    {"reps", withKeywords(CA_reps), METH_VARARGS | METH_KEYWORDS,
+     "Read-only (n,) view of the cell indices of the level-k representatives."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyGetSetDef CA_getset[] = {
+    {"L", CA_getL, nullptr, "Linear size of the lattice.", nullptr},
+    {"depth", CA_getDepth, nullptr, "Hierarchy depth d, L = 3^d.", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+PyType_Slot CA_slots[] = {
+    {Py_tp_new, reinterpret_cast<void*>(CA_new)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(CA_dealloc)},
+    {Py_tp_methods, CA_methods},
+    {Py_tp_getset, CA_getset},
+    {Py_tp_doc, const_cast<char*>("CA(L, U, fC, fN): Harrington decoder with colony size 3")},
+    {0, nullptr}
+};
+
+PyType_Spec CA_spec = {"harrington.CA", sizeof(PyCA), 0, Py_TPFLAGS_DEFAULT, CA_slots};
+
+// module functions
+
+PyObject* runTrials(PyObject*, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"L", "p", "U", "fC", "fN", "n", "threads", nullptr};
+    int L, U, n;
+    int threads = 1;
+    double p, fC, fN;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "ididdi|i", const_cast<char**>(kwlist),
+                                     &L, &p, &U, &fC, &fN, &n, &threads)) {
+        return nullptr;
+    }
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "n must be non-negative");
+        return nullptr;
+    }
+    if (threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "threads must be at least 1");
+        return nullptr;
+    }
+    if (!checkParams(L, U)) {
+        return nullptr;
+    }
+
+    npy_intp dims[1] = {n};
+    PyObject* lifetimes = PyArray_SimpleNew(1, dims, NPY_INT);
+    if (lifetimes == nullptr) {
+        return nullptr;
+    }
+    int* out = static_cast<int*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(lifetimes)));
+    std::atomic<bool> failed{false};
+
+    Py_BEGIN_ALLOW_THREADS
+    std::vector<std::thread> workers;
+    for (int t=0; t<threads; t++) {
+        workers.emplace_back([=, &failed]() {
+            try {
+                ToricCode tc(L);
+                CA ca(L,U,fC,fN);
+                for (int i=t; i<n; i+=threads) {
+                    out[i] = lifetime(tc, ca, p);
+                }
+            } catch (const std::bad_alloc&) {
+                failed = true;
+            }
+        });
+    }
+    for (std::thread& w : workers) {
+        w.join();
+    }
+    Py_END_ALLOW_THREADS
+
+    if (failed) {
+        Py_DECREF(lifetimes);
+        return PyErr_NoMemory();
+    }
+    return lifetimes;
+}
+
+PyMethodDef module_methods[] = {
+    {"run_trials", withKeywords(runTrials), METH_VARARGS | METH_KEYWORDS,
+     "run_trials(L, p, U, fC, fN, n, threads=1): run n independent trials and return their lifetimes "
+     "(steps until logical error)."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT, "harrington", "Harrington cellular-automaton decoder for the toric code",
+    -1, module_methods, nullptr, nullptr, nullptr, nullptr
+};
+
+// Location as an IntEnum, so dir arguments and step() output read as names
+PyObject* locationEnum() {
+    PyObject* members = Py_BuildValue("{s:i,s:i,s:i,s:i,s:i,s:i,s:i,s:i,s:i,s:i}",
+        "N", Location::N, "W", Location::W, "E", Location::E, "S", Location::S,
+        "NW", Location::NW, "NE", Location::NE, "SW", Location::SW, "SE", Location::SE,
+        "C", Location::C, "None_", Location::None);
+    PyObject* enumModule = PyImport_ImportModule("enum");
+    PyObject* loc = nullptr;
+    if (members != nullptr && enumModule != nullptr) {
+        loc = PyObject_CallMethod(enumModule, "IntEnum", "sO", "Location", members);
+    }
+    Py_XDECREF(members);
+    Py_XDECREF(enumModule);
+    return loc;
+}
+
+}
+
+PyMODINIT_FUNC PyInit_harrington() {
+    import_array();
+
+    PyObject* m = PyModule_Create(&module_def);
+    if (m == nullptr) {
+        return nullptr;
+    }
+    ToricCodeType = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(&ToricCode_spec));
+    CAType = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(&CA_spec));
+    PyObject* loc = locationEnum();
+    if (ToricCodeType == nullptr || CAType == nullptr || loc == nullptr
+        || PyModule_AddObjectRef(m, "ToricCode", reinterpret_cast<PyObject*>(ToricCodeType)) < 0
+        || PyModule_AddObjectRef(m, "CA", reinterpret_cast<PyObject*>(CAType)) < 0
+        || PyModule_AddObject(m, "Location", loc) < 0) {
+        Py_XDECREF(loc);
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
@@ -0,0 +1,25 @@
+# Builds the harrington extension next to this file:
+#
+#   python3 setup.py build_ext --inplace
+
+import os
+
+import numpy
+from setuptools import Extension, setup
+
+here = os.path.dirname(os.path.abspath(__file__))
+root = os.path.dirname(here)
+sources = ["CA.cpp", "Cell.cpp", "Topology.cpp", "ToricCode.cpp", "Location.cpp"]
+
+setup(
+    name="harrington",
+    ext_modules=[
+        Extension(
+            "harrington",
+            sources=[os.path.join(here, "harrington.cpp")] + [os.path.join(root, s) for s in sources],
+            include_dirs=[numpy.get_include()],
+            extra_compile_args=["-std=c++17", "-O3"],
+            language="c++",
+        )
+    ],
+)
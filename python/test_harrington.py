@@ -0,0 +1,88 @@
+# Smoke test for the harrington extension. Build it first (see setup.py), then
+#
+#   python3 test_harrington.py
+
+import unittest
+
+import numpy as np
+
+import harrington
+
+
+class ToricCodeTest(unittest.TestCase):
+
+    def test_flip_updates_syndromes(self):
+        tc = harrington.ToricCode(9)
+        tc.flip(0, 0, harrington.Location.N)
+        self.assertTrue(tc.qubits[0, 0, 0])
+        self.assertEqual(sorted(zip(*np.nonzero(tc.syndromes))), [(0, 0), (8, 0)])
+
+        tc.apply_flips(np.array([0]))  # same qubit again
+        self.assertFalse(tc.qubits.any())
+        self.assertFalse(tc.syndromes.any())
+
+    def test_views_are_read_only(self):
+        tc = harrington.ToricCode(9)
+        for view in (tc.qubits, tc.syndromes):
+            with self.assertRaises(ValueError):
+                view[0, 0] = True
+            with self.assertRaises(ValueError):
+                view.flags.writeable = True
+
+    def test_out_of_range(self):
+        tc = harrington.ToricCode(9)
+        with self.assertRaises(IndexError):
+            tc.flip(9, 0, harrington.Location.N)
+        with self.assertRaises(IndexError):
+            tc.apply_flips([0, 2*9*9])
+        self.assertFalse(tc.qubits.any())  # nothing applied
+
+
+class CATest(unittest.TestCase):
+
+    def test_step(self):
+        tc = harrington.ToricCode(27)
+        ca = harrington.CA(27, 10, 0.9, 0.4)
+        self.assertEqual(ca.depth, 3)
+        tc.set_seed(1)
+        for _ in range(50):
+            tc.noise(1e-2)
+            corrections = ca.step(tc)
+            self.assertEqual(corrections.ndim, 2)
+            self.assertEqual(corrections.shape[1], 3)
+        self.assertEqual(ca.count_sig(1).shape, (27, 27))
+        self.assertEqual(ca.count(1).shape, (9, 9))
+        self.assertEqual(list(ca.reps(0)), [i*27 + j for i in range(1, 27, 3) for j in range(1, 27, 3)])
+
+    def test_views_are_read_only(self):
+        ca = harrington.CA(27, 10, 0.9, 0.4)
+        for view in (ca.count_sig(0), ca.flip_sig(0), ca.count(0), ca.reps(0)):
+            with self.assertRaises(ValueError):
+                view[0] = 1
+        with self.assertRaises(IndexError):
+            ca.reps(2)
+
+    def test_bad_parameters(self):
+        with self.assertRaises(ValueError):
+            harrington.CA(10, 10, 0.9, 0.4)
+        with self.assertRaises(ValueError):
+            harrington.CA(9, 3, 0.9, 0.4)
+
+
+class RunTrialsTest(unittest.TestCase):
+
+    def test_lifetimes(self):
+        lifetimes = harrington.run_trials(9, 1e-2, 10, 0.9, 0.4, n=20, threads=3)
+        self.assertEqual(lifetimes.shape, (20,))
+        self.assertTrue((lifetimes > 0).all())
+        self.assertEqual(len(harrington.run_trials(9, 1e-2, 10, 0.9, 0.4, n=0)), 0)
+
+    def test_bad_arguments(self):
+        with self.assertRaises(ValueError):
+            harrington.run_trials(9, 1e-2, 10, 0.9, 0.4, n=5, threads=0)
+        with self.assertRaises(ValueError):
+            harrington.run_trials(9, 1e-2, 10, 0.9, 0.4, n=-1)
+
+
+if __name__ == "__main__":
+    unittest.main()